@@ -4,18 +4,30 @@
 #define __HRPC_CLIENT_H__
 
 #include <asio.hpp>
+#include <chrono>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <unordered_map>
 
 #include "common.h"
+#include "detail/result_cache.h"
 #include "detail/serdes.h"
 
 namespace hrpc {
 
 class client {
 public:
-    client(std::string_view addr, uint16_t port) : socket(io_ctx) {
+    struct cache_stats {
+        uint64_t hits;
+        uint64_t misses;
+        size_t size;
+    };
+
+    //! \brief Connects to a server. `cache_capacity` bounds the number of
+    //! results kept for ids marked with `cacheable`; 0 disables caching.
+    client(std::string_view addr, uint16_t port, size_t cache_capacity = 0)
+        : socket(io_ctx), cache(cache_capacity), hits(0), misses(0) {
         asio::ip::tcp::endpoint ep = {
             asio::ip::address::from_string(addr.data()), port};
         socket.connect(ep);
@@ -26,21 +38,59 @@ public:
         socket.close(err);
     }
 
+    //! \brief Marks handler `id` as idempotent, so that repeated calls with
+    //! identical arguments are answered from the local cache. A zero `ttl`
+    //! keeps results until they are evicted.
+    void cacheable(hrpc_id_t id, std::chrono::nanoseconds ttl =
+                                     std::chrono::nanoseconds::zero()) {
+        cacheable_ids[id] =
+            std::chrono::duration_cast<detail::result_cache::clock::duration>(
+                ttl);
+    }
+
+    cache_stats get_cache_stats() const { return {hits, misses, cache.size()}; }
+
+    void clear_cache() { cache.clear(); }
+
     template <typename R, typename... Args> R call(hrpc_id_t id, Args... args) {
-        // Send the request to server
-        uint8_t *buf = new uint8_t[sizeof(std::tuple<Args...>)];
+        size_t constexpr req_size =
+            detail::serialized_size<std::tuple<Args...>>;
+
+        // Zero-filled so that padding between tuple elements is deterministic
+        // in cache keys. Padding inside struct arguments is copied as-is.
+        uint8_t buf[sizeof(std::tuple<Args...>)] = {};
         detail::serialize(buf, std::forward_as_tuple(args...));
+
+        using resp_type = std::conditional_t<std::is_void_v<R>, uint8_t, R>;
+        resp_type resp;
+
+        auto cacheable_it = cacheable_ids.find(id);
+        std::string key;
+        if (cacheable_it != cacheable_ids.end()) {
+            key = detail::result_cache::make_key(id, buf, req_size);
+            if (cache.lookup(key, reinterpret_cast<uint8_t *>(&resp),
+                             sizeof(resp))) {
+                ++hits;
+                if constexpr (!std::is_void_v<R>) {
+                    return resp;
+                } else {
+                    return;
+                }
+            }
+            ++misses;
+        }
+
+        // Send the request to server
         socket.send(asio::buffer(&id, sizeof(id)));
-        socket.send(asio::buffer(buf, sizeof(std::tuple<Args...>)));
-        delete[] buf;
+        socket.send(asio::buffer(buf, req_size));
 
         // Receive response
-        if constexpr (std::is_void_v<R>) {
-            uint8_t resp;
-            socket.receive(asio::buffer(&resp, sizeof(resp)));
-        } else {
-            R resp;
-            socket.receive(asio::buffer(&resp, sizeof(resp)));
+        socket.receive(asio::buffer(&resp, sizeof(resp)));
+        if (cacheable_it != cacheable_ids.end()) {
+            cache.insert(std::move(key), reinterpret_cast<uint8_t *>(&resp),
+                         sizeof(resp), cacheable_it->second);
+        }
+        if constexpr (!std::is_void_v<R>) {
             return resp;
         }
     }
@@ -48,6 +98,12 @@ public:
 protected:
     asio::io_service io_ctx;
     asio::ip::tcp::socket socket;
+
+    std::unordered_map<hrpc_id_t, detail::result_cache::clock::duration>
+        cacheable_ids;
+    detail::result_cache cache;
+    uint64_t hits;
+    uint64_t misses;
 }; // class client
 
 } // namespace hrpc
@@ -0,0 +1,104 @@
+#pragma once
+
+#ifndef __HRPC_DETAIL_RESULT_CACHE_H__
+#define __HRPC_DETAIL_RESULT_CACHE_H__
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "../common.h"
+
+namespace hrpc::detail {
+
+//! \brief Bounded LRU cache mapping (id, serialized args) to raw response
+//! bytes. Entries optionally expire after a per-entry time-to-live.
+class result_cache {
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit result_cache(size_t capacity) : capacity(capacity) {}
+
+    static std::string make_key(hrpc_id_t id, uint8_t const *args,
+                                size_t args_size) {
+        std::string key(sizeof(id) + args_size, '\0');
+        std::memcpy(key.data(), &id, sizeof(id));
+        std::memcpy(key.data() + sizeof(id), args, args_size);
+        return key;
+    }
+
+    //! \brief Copies the cached response into `resp` and returns true on a
+    //! live hit; expired entries are evicted and reported as a miss.
+    bool lookup(std::string const &key, uint8_t *resp, size_t resp_size) {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return false;
+        }
+        auto entry = it->second;
+        if (entry->expires_at != clock::time_point::max() &&
+            clock::now() >= entry->expires_at) {
+            index.erase(it);
+            entries.erase(entry);
+            return false;
+        }
+        if (entry->resp.size() != resp_size) {
+            return false;
+        }
+        std::memcpy(resp, entry->resp.data(), resp_size);
+        entries.splice(entries.begin(), entries, entry);
+        return true;
+    }
+
+    //! \brief Inserts or refreshes an entry. A zero `ttl` never expires.
+    void insert(std::string key, uint8_t const *resp, size_t resp_size,
+                clock::duration ttl) {
+        if (capacity == 0) {
+            return;
+        }
+        auto expires_at = ttl == clock::duration::zero()
+                              ? clock::time_point::max()
+                              : clock::now() + ttl;
+        std::string value(reinterpret_cast<char const *>(resp), resp_size);
+
+        auto it = index.find(key);
+        if (it != index.end()) {
+            it->second->resp = std::move(value);
+            it->second->expires_at = expires_at;
+            entries.splice(entries.begin(), entries, it->second);
+            return;
+        }
+        if (entries.size() >= capacity) {
+            index.erase(entries.back().key);
+            entries.pop_back();
+        }
+        entries.push_front({key, std::move(value), expires_at});
+        index.emplace(std::move(key), entries.begin());
+    }
+
+    void clear() {
+        index.clear();
+        entries.clear();
+    }
+
+    size_t size() const { return entries.size(); }
+
+private:
+    struct entry {
+        std::string key;
+        std::string resp;
+        clock::time_point expires_at;
+    };
+
+    size_t capacity;
+    std::list<entry> entries;
+    std::unordered_map<std::string, std::list<entry>::iterator> index;
+}; // class result_cache
+
+} // namespace hrpc::detail
+
+#endif // __HRPC_DETAIL_RESULT_CACHE_H__
@@ -46,6 +46,12 @@ auto deserialize(uint8_t const *buf) {
 
 } // namespace serdes
 
+//! \brief Number of bytes `Args` occupies on the wire. An empty tuple still
+//! has size 1, but zero-arg calls carry no argument bytes at all.
+template <typename Args>
+inline constexpr std::size_t serialized_size =
+    std::tuple_size_v<Args> == 0 ? 0 : sizeof(Args);
+
 template <typename... T>
 void serialize(uint8_t *buf, std::tuple<T...> const &args) {
     serdes::serialize<0, 0>(buf, args);
@@ -0,0 +1,144 @@
+#pragma once
+
+#ifndef __HRPC_DETAIL_TRACE_H__
+#define __HRPC_DETAIL_TRACE_H__
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../common.h"
+
+namespace hrpc::detail {
+
+// Trace layout: an 8-byte magic followed by records of
+// `trace_record_header` and `req_size` bytes of serialized arguments.
+// Like the RPC wire format, traces are only portable between homogeneous
+// machines. A process killed while capturing may leave a partial final
+// record, which readers treat as the end of the trace.
+inline constexpr char trace_magic[8] = {'H', 'R', 'P', 'C',
+                                        'T', 'R', 'C', '1'};
+
+struct trace_record_header {
+    uint64_t timestamp_ns; // since capture start
+    hrpc_id_t id;
+    uint32_t req_size;
+    uint32_t resp_size;
+};
+
+struct trace_record {
+    uint64_t timestamp_ns;
+    hrpc_id_t id;
+    uint32_t resp_size;
+    std::vector<uint8_t> req;
+};
+
+class trace_writer {
+public:
+    // Buffered records are handed to the OS after this many records or this
+    // much time, whichever comes first, so that little is lost if the
+    // capturing process is killed.
+    static constexpr size_t flush_records = 256;
+    static constexpr auto flush_interval = std::chrono::milliseconds(100);
+
+    explicit trace_writer(std::string_view path)
+        : out(std::string(path), std::ios::binary | std::ios::trunc),
+          start(std::chrono::steady_clock::now()), last_flush(start),
+          unflushed(0) {
+        if (!out) {
+            throw std::runtime_error("cannot open trace file " +
+                                     std::string(path));
+        }
+        out.write(trace_magic, sizeof(trace_magic));
+        flush();
+    }
+
+    //! \brief Appends one record. Throws if the trace can no longer be
+    //! written, e.g. because the disk is full.
+    void write(hrpc_id_t id, uint8_t const *req, size_t req_size,
+               size_t resp_size) {
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = now - start;
+        trace_record_header hdr = {
+            static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                    .count()),
+            id, static_cast<uint32_t>(req_size),
+            static_cast<uint32_t>(resp_size)};
+        out.write(reinterpret_cast<char const *>(&hdr), sizeof(hdr));
+        out.write(reinterpret_cast<char const *>(req), req_size);
+
+        if (++unflushed >= flush_records ||
+            now - last_flush >= flush_interval) {
+            last_flush = now;
+            flush();
+        } else if (!out) {
+            throw std::runtime_error("failed to write hrpc trace");
+        }
+    }
+
+    void flush() {
+        out.flush();
+        unflushed = 0;
+        if (!out) {
+            throw std::runtime_error("failed to write hrpc trace");
+        }
+    }
+
+private:
+    std::ofstream out;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point last_flush;
+    size_t unflushed;
+}; // class trace_writer
+
+class trace_reader {
+public:
+    explicit trace_reader(std::string_view path)
+        : in(std::string(path), std::ios::binary), is_truncated(false) {
+        if (!in) {
+            throw std::runtime_error("cannot open trace file " +
+                                     std::string(path));
+        }
+        char magic[sizeof(trace_magic)];
+        if (!in.read(magic, sizeof(magic)) ||
+            std::memcmp(magic, trace_magic, sizeof(magic)) != 0) {
+            throw std::runtime_error("not an hrpc trace: " +
+                                     std::string(path));
+        }
+    }
+
+    //! \brief Reads the next record; returns false at end of trace. A partial
+    //! final record also ends the trace, and sets `truncated()`.
+    bool next(trace_record &rec) {
+        trace_record_header hdr;
+        if (!in.read(reinterpret_cast<char *>(&hdr), sizeof(hdr))) {
+            is_truncated = in.gcount() > 0;
+            return false;
+        }
+        rec.timestamp_ns = hdr.timestamp_ns;
+        rec.id = hdr.id;
+        rec.resp_size = hdr.resp_size;
+        rec.req.resize(hdr.req_size);
+        if (!in.read(reinterpret_cast<char *>(rec.req.data()), hdr.req_size)) {
+            is_truncated = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool truncated() const { return is_truncated; }
+
+private:
+    std::ifstream in;
+    bool is_truncated;
+}; // class trace_reader
+
+} // namespace hrpc::detail
+
+#endif // __HRPC_DETAIL_TRACE_H__
@@ -5,7 +5,10 @@
 
 #include <atomic>
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -20,12 +23,14 @@
 #include "detail/func_traits.h"
 #include "detail/remove_first_arg.h"
 #include "detail/serdes.h"
+#include "detail/trace.h"
 
 namespace hrpc {
 
 class server {
 public:
-    server(uint16_t port) : port(port), acceptor(io_ctx), should_stop(false) {}
+    server(uint16_t port)
+        : port(port), acceptor(io_ctx), should_stop(false), capturing(false) {}
     ~server() {
         should_stop = true;
 
@@ -61,6 +66,27 @@ public:
 
     void stop() { should_stop = true; }
 
+    //! \brief Records every dispatched request (id and argument bytes) with
+    //! its arrival time into a binary trace at `path`, replacing any trace
+    //! currently being captured. Safe to call from any thread, including
+    //! while the server is running. Failing to write the trace throws from
+    //! `run()`, like socket errors do.
+    void start_capture(std::string_view path) {
+        auto writer = std::make_unique<detail::trace_writer>(path);
+        std::lock_guard<std::mutex> lock(capture_mutex);
+        capture = std::move(writer);
+        capturing = true;
+    }
+
+    void stop_capture() {
+        std::unique_ptr<detail::trace_writer> writer;
+        {
+            std::lock_guard<std::mutex> lock(capture_mutex);
+            capturing = false;
+            writer = std::move(capture);
+        }
+    }
+
 protected:
     void start_accept() {
         connections.emplace_back(asio::ip::tcp::socket(io_ctx), 0);
@@ -95,15 +121,24 @@ protected:
                 // Retrieve request
                 size_t req_size = it->second.req_size;
                 uint8_t *req_buf = new uint8_t[req_size];
-                connections[index].socket.receive(
-                    asio::buffer(req_buf, req_size));
+                asio::read(connections[index].socket,
+                           asio::buffer(req_buf, req_size),
+                           asio::transfer_all());
 
                 // Get & send response
                 size_t resp_size = it->second.resp_size;
+                if (capturing) {
+                    std::lock_guard<std::mutex> lock(capture_mutex);
+                    if (capture) {
+                        capture->write(id, req_buf, req_size, resp_size);
+                    }
+                }
                 uint8_t *resp_buf = new uint8_t[resp_size];
                 it->second.adaptor(req_buf, resp_buf);
-                connections[index].socket.send(
-                    asio::buffer(resp_buf, resp_size));
+                asio::write(connections[index].socket,
+                            asio::buffer(resp_buf, resp_size));
+                delete[] req_buf;
+                delete[] resp_buf;
             }
         }
         start_receive(index);
@@ -153,7 +188,7 @@ protected:
             using real_args_type =
                 typename detail::remove_first_arg<args_type>::type;
             handlers[id] = {
-                sizeof(args_type), 1,
+                detail::serialized_size<real_args_type>, 1,
                 [this, func](uint8_t const *req_buf, uint8_t *resp_buf) {
                     auto req_args =
                         detail::deserialize<real_args_type>(req_buf);
@@ -200,7 +235,7 @@ protected:
             using real_args_type =
                 typename detail::remove_first_arg<args_type>::type;
             handlers[id] = {
-                sizeof(args_type), sizeof(result_type),
+                detail::serialized_size<real_args_type>, sizeof(result_type),
                 [this, func](uint8_t const *req_buf, uint8_t *resp_buf) {
                     auto req_args =
                         detail::deserialize<real_args_type>(req_buf);
@@ -225,12 +260,16 @@ protected:
     asio::io_service io_ctx;
     asio::ip::tcp::acceptor acceptor;
     std::atomic<bool> should_stop;
+    std::atomic<bool> capturing;
+    std::mutex capture_mutex;
+    std::unique_ptr<detail::trace_writer> capture;
 
     struct identified_connection {
         asio::ip::tcp::socket socket;
         hrpc_id_t id;
     };
-    std::vector<identified_connection> connections;
+    // Pending async ops hold references into this, so it must not relocate
+    std::deque<identified_connection> connections;
 
     using adaptor_type = std::function<void(uint8_t *, uint8_t *)>;
     struct sized_handler {
@@ -0,0 +1,54 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#include <hrpc/client.h>
+#include <hrpc/server.h>
+
+#include <cassert>
+
+static constexpr uint16_t port = 8392;
+static constexpr hrpc::hrpc_id_t ADD = 0x1;
+static constexpr hrpc::hrpc_id_t COUNT = 0x2;
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        hrpc::client client(argv[1], port, 16);
+        client.cacheable(ADD);
+        client.cacheable(COUNT, std::chrono::milliseconds(100));
+        std::cout << "client built" << std::endl;
+
+        auto ret = client.call<int>(ADD, 1, 2);
+        std::cout << ret << std::endl;
+        ret = client.call<int>(ADD, 1, 2);
+        std::cout << ret << std::endl;
+        ret = client.call<int>(ADD, 2, 2);
+        std::cout << ret << std::endl;
+
+        auto first = client.call<int>(COUNT);
+        auto cached = client.call<int>(COUNT);
+        assert(first == cached);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        auto expired = client.call<int>(COUNT);
+        assert(expired != first);
+
+        auto stats = client.get_cache_stats();
+        std::cout << "hits " << stats.hits << ", misses " << stats.misses
+                  << std::endl;
+        assert(stats.hits == 2 && stats.misses == 4);
+    } else {
+        hrpc::server server(port);
+        std::cout << "server built" << std::endl;
+
+        int calls = 0;
+        server.bind(ADD, [](int a, int b) { return a + b; });
+        server.bind(COUNT, [&]() { return ++calls; });
+        std::cout << "handler bound" << std::endl;
+
+        server.run();
+    }
+    return 0;
+}
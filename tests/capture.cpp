@@ -0,0 +1,64 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <tuple>
+
+#include <hrpc/client.h>
+#include <hrpc/detail/trace.h>
+#include <hrpc/server.h>
+
+#include <cassert>
+
+static constexpr uint16_t port = 8392;
+static constexpr hrpc::hrpc_id_t DONE = 0x0;
+static constexpr hrpc::hrpc_id_t ADD = 0x1;
+static constexpr char const *trace_path = "capture.trace";
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        hrpc::client client(argv[1], port);
+        std::cout << "client built" << std::endl;
+
+        auto ret = client.call<int>(ADD, 1, 2);
+        std::cout << ret << std::endl;
+        ret = client.call<int>(ADD, 3, 4);
+        std::cout << ret << std::endl;
+
+        client.call<void>(DONE);
+    } else {
+        hrpc::server server(port);
+        std::cout << "server built" << std::endl;
+
+        server.bind(DONE, [&]() { server.stop(); });
+        server.bind(ADD, [](int a, int b) { return a + b; });
+        server.start_capture(trace_path);
+        std::cout << "handler bound" << std::endl;
+
+        server.run();
+        server.stop_capture();
+
+        hrpc::detail::trace_reader reader(trace_path);
+        hrpc::detail::trace_record rec;
+        uint64_t last_ts = 0;
+        int count = 0;
+        while (reader.next(rec)) {
+            assert(rec.timestamp_ns >= last_ts);
+            last_ts = rec.timestamp_ns;
+            std::cout << "id " << rec.id << ", " << rec.req.size()
+                      << " arg bytes, " << rec.resp_size << " resp bytes";
+            if (rec.id == ADD) {
+                auto args = hrpc::detail::deserialize<std::tuple<int, int>>(
+                    rec.req.data());
+                std::cout << ", args " << std::get<0>(args) << " "
+                          << std::get<1>(args);
+            }
+            std::cout << std::endl;
+            count++;
+        }
+        assert(count == 3);
+        std::cout << "captured " << count << " requests" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,393 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <asio.hpp>
+
+#include <hrpc/common.h>
+#include <hrpc/detail/trace.h>
+
+// Open-loop load generator for hrpc servers.
+//
+// Requests are issued on a fixed schedule (from a captured trace, or a
+// synthetic Poisson arrival process) regardless of how fast the server
+// answers: they are spread round-robin over the connections and pipelined,
+// and since the server answers each connection in order, replies are matched
+// to requests first-in first-out. Latency is measured from each request's
+// scheduled send time, so queueing behind a saturated server shows up in the
+// percentiles. If the oldest outstanding request on a connection gets no
+// reply within the timeout, every request in flight on it is counted as
+// failed and it is re-established.
+//
+// The server silently drops requests for ids it has no handler for, and the
+// wire format carries no request tags, so such requests shift the reply
+// matching on their connection until the timeout fires: latencies measured
+// then are meaningless. Traces only contain dispatched requests, but
+// synthetic mixes must only use ids the target server binds.
+
+using clock_type = std::chrono::steady_clock;
+
+struct scheduled_request {
+    uint64_t offset_ns;
+    hrpc::hrpc_id_t id;
+    uint8_t const *req;
+    size_t req_size;
+    size_t resp_size;
+};
+
+struct mix_entry {
+    hrpc::hrpc_id_t id;
+    size_t req_size;
+    size_t resp_size;
+    std::vector<uint8_t> req;
+};
+
+static void usage(char const *prog) {
+    std::cerr
+        << "usage:\n"
+        << "  " << prog
+        << " <addr> <port> replay <trace> [-s speedup] [-c conns]"
+           " [-t timeout_ms]\n"
+        << "  " << prog
+        << " <addr> <port> synth <rate> <seconds> <id:req_size:resp_size>..."
+           " [-c conns] [-t timeout_ms]\n";
+    std::exit(1);
+}
+
+static mix_entry parse_mix(std::string_view spec) {
+    auto first = spec.find(':');
+    auto second = spec.find(':', first + 1);
+    if (first == spec.npos || second == spec.npos) {
+        throw std::invalid_argument("bad mix entry " + std::string(spec));
+    }
+    mix_entry entry;
+    entry.id = std::stoull(std::string(spec.substr(0, first)), nullptr, 0);
+    entry.req_size =
+        std::stoull(std::string(spec.substr(first + 1, second - first - 1)));
+    entry.resp_size = std::stoull(std::string(spec.substr(second + 1)));
+    entry.req.assign(entry.req_size, 0);
+    return entry;
+}
+
+class connection {
+public:
+    connection(asio::ip::tcp::endpoint const &ep,
+               std::chrono::milliseconds timeout)
+        : ep(ep), timeout(timeout), socket(io), send_timer(io), deadline(io) {}
+
+    bool connect(asio::error_code &err) {
+        socket.connect(ep, err);
+        if (!err) {
+            socket.set_option(asio::ip::tcp::no_delay(true), err);
+        }
+        return !err;
+    }
+
+    //! \brief Issues requests `first`, `first + stride`, ... of `schedule`
+    //! at their due times and collects their replies; returns when every one
+    //! has completed or failed.
+    void run(std::vector<scheduled_request> const &schedule, size_t first,
+             size_t stride, clock_type::time_point start) {
+        this->schedule = &schedule;
+        this->stride = stride;
+        this->start = start;
+        next = first;
+        schedule_send();
+        io.run();
+    }
+
+    std::vector<uint64_t> latencies;
+    size_t failed = 0;
+
+private:
+    clock_type::time_point due(size_t index) const {
+        return start +
+               std::chrono::nanoseconds((*schedule)[index].offset_ns);
+    }
+
+    void schedule_send() {
+        if (next >= schedule->size()) {
+            return;
+        }
+        send_timer.expires_at(due(next));
+        send_timer.async_wait([this](asio::error_code const &err) {
+            if (err) {
+                return;
+            }
+            in_flight.push_back(next);
+            write_queue.push_back(next);
+            next += stride;
+            start_write();
+            start_read();
+            schedule_send();
+        });
+    }
+
+    void start_write() {
+        if (writing || write_queue.empty()) {
+            return;
+        }
+        writing = true;
+        auto const &req = (*schedule)[write_queue.front()];
+        std::array<asio::const_buffer, 2> bufs = {
+            asio::buffer(&req.id, sizeof(req.id)),
+            asio::buffer(req.req, req.req_size)};
+        asio::async_write(socket, bufs,
+                          [this, gen = generation](asio::error_code const &err,
+                                                   size_t) {
+                              if (gen != generation) {
+                                  return;
+                              }
+                              writing = false;
+                              if (err) {
+                                  reset();
+                                  return;
+                              }
+                              write_queue.pop_front();
+                              start_write();
+                          });
+    }
+
+    void start_read() {
+        if (reading || in_flight.empty()) {
+            return;
+        }
+        reading = true;
+        size_t index = in_flight.front();
+        resp.resize((*schedule)[index].resp_size);
+
+        deadline.expires_at(due(index) + timeout);
+        deadline.async_wait([this, gen = generation,
+                             seq = reads](asio::error_code const &err) {
+            if (!err && gen == generation && seq == reads) {
+                reset();
+            }
+        });
+        asio::async_read(
+            socket, asio::buffer(resp),
+            [this, gen = generation, index](asio::error_code const &err,
+                                            size_t) {
+                if (gen != generation) {
+                    return;
+                }
+                reading = false;
+                reads++;
+                deadline.cancel();
+                if (err) {
+                    reset();
+                    return;
+                }
+                latencies.push_back(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        clock_type::now() - due(index))
+                        .count());
+                in_flight.pop_front();
+                start_read();
+            });
+    }
+
+    //! \brief Fails everything in flight and reconnects, since a late reply
+    //! would otherwise be mistaken for the reply to a later request.
+    void reset() {
+        failed += in_flight.size();
+        in_flight.clear();
+        write_queue.clear();
+        writing = false;
+        reading = false;
+        generation++;
+
+        asio::error_code err;
+        socket.close(err);
+        deadline.cancel();
+        if (!connect(err)) {
+            // Give up on this connection's remaining requests
+            send_timer.cancel();
+            for (; next < schedule->size(); next += stride) {
+                failed++;
+            }
+        }
+    }
+
+    asio::ip::tcp::endpoint ep;
+    std::chrono::milliseconds timeout;
+    asio::io_service io;
+    asio::ip::tcp::socket socket;
+    asio::steady_timer send_timer;
+    asio::steady_timer deadline;
+
+    std::vector<scheduled_request> const *schedule = nullptr;
+    size_t stride = 1;
+    size_t next = 0;
+    clock_type::time_point start;
+
+    std::deque<size_t> in_flight;   // sent or queued, awaiting replies
+    std::deque<size_t> write_queue; // not yet fully written
+    std::vector<uint8_t> resp;
+    bool writing = false;
+    bool reading = false;
+    uint64_t reads = 0;
+    uint64_t generation = 0;
+}; // class connection
+
+static uint64_t percentile(std::vector<uint64_t> const &sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[rank];
+}
+
+int main(int argc, char **argv) {
+    if (argc < 5) {
+        usage(argv[0]);
+    }
+    std::string addr = argv[1];
+    uint16_t port = static_cast<uint16_t>(std::atoi(argv[2]));
+    std::string_view mode = argv[3];
+
+    double speedup = 1.0;
+    size_t conns = 16;
+    std::chrono::milliseconds timeout(1000);
+    std::vector<std::string_view> positional;
+    for (int i = 4; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "-s" && i + 1 < argc) {
+            speedup = std::atof(argv[++i]);
+        } else if (arg == "-c" && i + 1 < argc) {
+            conns = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "-t" && i + 1 < argc) {
+            timeout = std::chrono::milliseconds(
+                std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (speedup <= 0 || conns == 0 || timeout.count() == 0) {
+        usage(argv[0]);
+    }
+
+    // Build the request schedule
+    std::vector<hrpc::detail::trace_record> records;
+    std::vector<mix_entry> mix;
+    std::vector<scheduled_request> schedule;
+    if (mode == "replay" && positional.size() == 1) {
+        try {
+            hrpc::detail::trace_reader reader(positional[0]);
+            hrpc::detail::trace_record rec;
+            while (reader.next(rec)) {
+                records.push_back(std::move(rec));
+            }
+            if (reader.truncated()) {
+                std::cerr << "warning: ignoring partial last record in "
+                          << positional[0] << std::endl;
+            }
+        } catch (std::exception const &e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        uint64_t base = records.empty() ? 0 : records.front().timestamp_ns;
+        for (auto const &r : records) {
+            schedule.push_back(
+                {static_cast<uint64_t>((r.timestamp_ns - base) / speedup),
+                 r.id, r.req.data(), r.req.size(), r.resp_size});
+        }
+    } else if (mode == "synth" && positional.size() >= 3) {
+        double rate = std::atof(std::string(positional[0]).c_str());
+        double seconds = std::atof(std::string(positional[1]).c_str());
+        for (size_t i = 2; i < positional.size(); i++) {
+            try {
+                mix.push_back(parse_mix(positional[i]));
+            } catch (std::exception const &) {
+                std::cerr << "bad mix entry " << positional[i] << std::endl;
+                usage(argv[0]);
+            }
+        }
+        if (rate <= 0 || seconds <= 0) {
+            usage(argv[0]);
+        }
+
+        std::mt19937_64 rng(42);
+        std::exponential_distribution<double> gap(rate);
+        std::uniform_int_distribution<size_t> pick(0, mix.size() - 1);
+        for (double t = gap(rng); t < seconds; t += gap(rng)) {
+            auto const &m = mix[pick(rng)];
+            schedule.push_back({static_cast<uint64_t>(t * 1e9), m.id,
+                                m.req.data(), m.req_size, m.resp_size});
+        }
+    } else {
+        usage(argv[0]);
+    }
+    if (schedule.empty()) {
+        std::cerr << "empty schedule" << std::endl;
+        return 1;
+    }
+
+    // Connect all workers before the clock starts
+    asio::error_code err;
+    auto ip = asio::ip::address::from_string(addr, err);
+    if (err) {
+        std::cerr << "bad address " << addr << ": " << err.message()
+                  << std::endl;
+        return 1;
+    }
+    asio::ip::tcp::endpoint ep = {ip, port};
+    std::vector<std::unique_ptr<connection>> connections;
+    for (size_t i = 0; i < conns; i++) {
+        connections.push_back(std::make_unique<connection>(ep, timeout));
+        if (!connections.back()->connect(err)) {
+            std::cerr << "cannot connect to " << addr << ":" << port << ": "
+                      << err.message() << std::endl;
+            return 1;
+        }
+    }
+
+    auto start = clock_type::now() + std::chrono::milliseconds(10);
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < conns; w++) {
+        workers.emplace_back([&, w]() {
+            connections[w]->run(schedule, w, conns, start);
+        });
+    }
+    for (auto &t : workers) {
+        t.join();
+    }
+    auto end = clock_type::now();
+
+    // Report
+    std::vector<uint64_t> all;
+    size_t failed = 0;
+    for (auto const &conn : connections) {
+        all.insert(all.end(), conn->latencies.begin(), conn->latencies.end());
+        failed += conn->failed;
+    }
+    std::sort(all.begin(), all.end());
+
+    double elapsed = std::chrono::duration<double>(end - start).count();
+    double offered = std::chrono::duration<double>(
+                         std::chrono::nanoseconds(schedule.back().offset_ns))
+                         .count();
+    std::cout << "requests:   " << all.size() << " / " << schedule.size()
+              << " (" << failed << " failed)\n";
+    if (offered > 0) {
+        std::cout << "offered:    " << schedule.size() / offered
+                  << " req/s\n";
+    }
+    std::cout << "achieved:   " << all.size() / elapsed << " req/s\n";
+    std::cout << "latency us: p50 " << percentile(all, 0.50) / 1e3 << ", p90 "
+              << percentile(all, 0.90) / 1e3 << ", p99 "
+              << percentile(all, 0.99) / 1e3 << ", p99.9 "
+              << percentile(all, 0.999) / 1e3 << ", max "
+              << (all.empty() ? 0 : all.back()) / 1e3 << std::endl;
+    return failed ? 1 : 0;
+}